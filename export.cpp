@@ -0,0 +1,564 @@
+#include "macros.hpp"
+#include "export.hpp"
+#include "stream.hpp"
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+/* ========================================================================== */
+/*                              Variáveis externas                            */
+/* ========================================================================== */
+
+// As variáveis e funções a seguir foram declaradas em `main.cpp`.
+
+// Provê acesso externo às duas matrizes do autômato.
+extern int cur_grid[AUTOMATON_HEIGHT][AUTOMATON_WIDTH];
+extern int old_grid[AUTOMATON_HEIGHT][AUTOMATON_WIDTH];
+
+// Provê acesso a algumas funções básicas para iterar o autômato.
+extern void copy_last_state();
+extern void apply_rules();
+
+/* ========================================================================== */
+/*                              Macros e Estruturas                           */
+/* ========================================================================== */
+
+/* Quantidade de quadros aguardando codificação, por thread. Quando a fila
+ * enche, o loop de gerações espera; assim a memória permanece limitada. */
+#define EXPORT_QUEUE_PER_THREAD 4
+
+/* Paleta RGB dos estados das células, indexada pelo estado. As cores vêm de
+ * `macros.hpp`, as mesmas utilizadas pela janela. */
+static const unsigned char cell_palette[3][3] = {
+    { CELL_RESTING_RGB },
+    { CELL_RECOVER_RGB },
+    { CELL_EXCITED_RGB },
+};
+
+/* Uma cópia do estado do autômato, a ser rasterizada e codificada */
+struct export_job_t {
+    unsigned long frame;
+    unsigned char cells[AUTOMATON_HEIGHT][AUTOMATON_WIDTH];
+};
+
+/* Estado compartilhado entre o loop de gerações e as threads de codificação */
+struct export_state_t {
+    const export_options_t*  options;
+    FILE*                    stream;     // Saída Y4M; NULL para PNG
+    std::mutex               lock;
+    std::condition_variable  has_jobs;
+    std::condition_variable  has_room;
+    std::condition_variable  next_turn;  // Ordem de escrita do Y4M
+    std::deque<export_job_t> queue;
+    size_t                   capacity;
+    unsigned long            next_write;
+    bool                     finished;
+    std::atomic<bool>        failed;
+};
+
+
+/* ========================================================================== */
+/*                              Rasterização                                  */
+/* ========================================================================== */
+
+// Rasteriza um quadro em um buffer RGB, com `scale` pixels por lado de cada
+// célula. A imagem tem a mesma orientação da janela: a linha 0 é o topo.
+static void
+rasterize_frame(const export_job_t& job, unsigned scale,
+                std::vector<unsigned char>& rgb)
+{
+    const size_t stride = (size_t) AUTOMATON_WIDTH * scale * 3;
+    rgb.resize(stride * AUTOMATON_HEIGHT * scale);
+
+    for(int i = 0; i < AUTOMATON_HEIGHT; i++) {
+        unsigned char* row = &rgb[(size_t) i * scale * stride];
+
+        // Preenche a primeira linha de pixels da fileira de células...
+        unsigned char* px = row;
+        for(int j = 0; j < AUTOMATON_WIDTH; j++) {
+            const unsigned char* color = cell_palette[job.cells[i][j]];
+            for(unsigned k = 0; k < scale; k++) {
+                *px++ = color[0];
+                *px++ = color[1];
+                *px++ = color[2];
+            }
+        }
+
+        // ...e replica-a para as demais linhas da mesma fileira.
+        for(unsigned k = 1; k < scale; k++) {
+            memcpy(row + k * stride, row, stride);
+        }
+    }
+}
+
+
+/* ========================================================================== */
+/*                             Codificação PNG                                */
+/* ========================================================================== */
+
+/* O PNG é escrito sem dependências externas. A compressão é um DEFLATE com
+ * códigos de Huffman fixos, em que as únicas repetições procuradas são as do
+ * pixel anterior (distância 3). Como as células são blocos de cor sólida,
+ * isto basta para reduzir drasticamente o tamanho de cada quadro. */
+
+// Tabela de CRC-32, preenchida uma única vez antes de iniciar as threads.
+static uint32_t crc_table[256];
+
+static void
+init_crc_table()
+{
+    for(uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for(int k = 0; k < 8; k++) {
+            c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        }
+        crc_table[n] = c;
+    }
+}
+
+static uint32_t
+crc32(const unsigned char* data, size_t len, uint32_t crc = 0xFFFFFFFFu)
+{
+    for(size_t i = 0; i < len; i++) {
+        crc = crc_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static uint32_t
+adler32(const unsigned char* data, size_t len)
+{
+    uint32_t a = 1, b = 0;
+    for(size_t i = 0; i < len; i++) {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+static void
+put_u32_be(std::vector<unsigned char>& out, uint32_t value)
+{
+    out.push_back((value >> 24) & 0xFF);
+    out.push_back((value >> 16) & 0xFF);
+    out.push_back((value >> 8)  & 0xFF);
+    out.push_back(value & 0xFF);
+}
+
+/* Escritor de bits do DEFLATE: os bits são empacotados a partir do menos
+ * significativo de cada byte. */
+struct bit_writer_t {
+    std::vector<unsigned char>& out;
+    uint32_t acc;
+    int      nbits;
+
+    void put(uint32_t bits, int n) {
+        acc |= bits << nbits;
+        nbits += n;
+        while(nbits >= 8) {
+            out.push_back(acc & 0xFF);
+            acc >>= 8;
+            nbits -= 8;
+        }
+    }
+
+    // Códigos de Huffman são definidos a partir do bit mais significativo,
+    // portanto precisam ser invertidos antes da escrita.
+    void put_code(uint32_t code, int n) {
+        uint32_t reversed = 0;
+        for(int i = 0; i < n; i++) {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        put(reversed, n);
+    }
+
+    void flush() {
+        if(nbits > 0) {
+            out.push_back(acc & 0xFF);
+        }
+        acc = 0;
+        nbits = 0;
+    }
+};
+
+// Escreve um símbolo literal/comprimento na tabela de Huffman fixa.
+static void
+put_fixed_symbol(bit_writer_t& bw, int symbol)
+{
+    if(symbol < 144) {
+        bw.put_code(0x30 + symbol, 8);
+    } else if(symbol < 256) {
+        bw.put_code(0x190 + (symbol - 144), 9);
+    } else if(symbol < 280) {
+        bw.put_code(symbol - 256, 7);
+    } else {
+        bw.put_code(0xC0 + (symbol - 280), 8);
+    }
+}
+
+// Escreve uma repetição de `length` bytes (3 a 258) à distância 3.
+static void
+put_fixed_match(bit_writer_t& bw, int length)
+{
+    static const int base[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+    };
+    static const int extra[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+    };
+
+    int code = 28;
+    while(base[code] > length) {
+        code--;
+    }
+
+    put_fixed_symbol(bw, 257 + code);
+    bw.put(length - base[code], extra[code]);
+
+    // Distância 3 é o código 2, com cinco bits e nenhum bit extra.
+    bw.put_code(2, 5);
+}
+
+// Comprime `data` em um fluxo zlib, anexando-o a `out`.
+static void
+zlib_compress(const std::vector<unsigned char>& data,
+              std::vector<unsigned char>& out)
+{
+    // Cabeçalho zlib: DEFLATE, janela de 32K, sem dicionário.
+    out.push_back(0x78);
+    out.push_back(0x01);
+
+    bit_writer_t bw = { out, 0, 0 };
+    bw.put(1, 1); // Último bloco
+    bw.put(1, 2); // Huffman fixo
+
+    const size_t len = data.size();
+    size_t i = 0;
+    while(i < len) {
+        size_t run = 0;
+        if(i >= 3) {
+            while((i + run < len) && (run < 258)
+                  && (data[i + run] == data[i + run - 3])) {
+                run++;
+            }
+        }
+
+        if(run >= 3) {
+            put_fixed_match(bw, (int) run);
+            i += run;
+        } else {
+            put_fixed_symbol(bw, data[i]);
+            i++;
+        }
+    }
+
+    put_fixed_symbol(bw, 256); // Fim do bloco
+    bw.flush();
+
+    put_u32_be(out, adler32(data.data(), len));
+}
+
+// Anexa um chunk PNG de tipo `type` a `out`.
+static void
+put_png_chunk(std::vector<unsigned char>& out, const char* type,
+              const unsigned char* data, size_t len)
+{
+    put_u32_be(out, (uint32_t) len);
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + len);
+    put_u32_be(out, crc32(&out[start], len + 4) ^ 0xFFFFFFFFu);
+}
+
+// Codifica um buffer RGB como PNG. `scratch` é reutilizado entre quadros
+// pela mesma thread, para evitar realocações.
+static void
+encode_png(const std::vector<unsigned char>& rgb, unsigned width,
+           unsigned height, std::vector<unsigned char>& scratch,
+           std::vector<unsigned char>& png)
+{
+    static const unsigned char signature[8] = {
+        0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'
+    };
+
+    // Cada linha da imagem é precedida pelo seu tipo de filtro (0: nenhum).
+    const size_t stride = (size_t) width * 3;
+    scratch.clear();
+    for(unsigned y = 0; y < height; y++) {
+        scratch.push_back(0);
+        scratch.insert(scratch.end(), &rgb[y * stride],
+                       &rgb[y * stride] + stride);
+    }
+
+    std::vector<unsigned char> ihdr;
+    put_u32_be(ihdr, width);
+    put_u32_be(ihdr, height);
+    ihdr.push_back(8); // Bits por canal
+    ihdr.push_back(2); // RGB
+    ihdr.push_back(0); // Compressão
+    ihdr.push_back(0); // Filtragem
+    ihdr.push_back(0); // Sem entrelaçamento
+
+    std::vector<unsigned char> idat;
+    zlib_compress(scratch, idat);
+
+    png.assign(signature, signature + 8);
+    put_png_chunk(png, "IHDR", ihdr.data(), ihdr.size());
+    put_png_chunk(png, "IDAT", idat.data(), idat.size());
+    put_png_chunk(png, "IEND", NULL, 0);
+}
+
+
+/* ========================================================================== */
+/*                             Codificação Y4M                                */
+/* ========================================================================== */
+
+/* O Y4M é um fluxo de vídeo cru, aceito diretamente por ferramentas como o
+ * ffmpeg. Usamos amostragem 4:4:4, de forma que qualquer escala é válida. */
+
+// Converte um buffer RGB em um quadro Y4M (planos Y, Cb e Cr, BT.601).
+static void
+encode_y4m_frame(const std::vector<unsigned char>& rgb,
+                 std::vector<unsigned char>& frame)
+{
+    static const char tag[] = "FRAME\n";
+    const size_t pixels = rgb.size() / 3;
+
+    frame.resize(sizeof(tag) - 1 + pixels * 3);
+    memcpy(&frame[0], tag, sizeof(tag) - 1);
+
+    unsigned char* y  = &frame[sizeof(tag) - 1];
+    unsigned char* cb = y + pixels;
+    unsigned char* cr = cb + pixels;
+
+    for(size_t i = 0; i < pixels; i++) {
+        int r = rgb[i * 3], g = rgb[i * 3 + 1], b = rgb[i * 3 + 2];
+        y[i]  = (unsigned char) (( 66 * r + 129 * g +  25 * b + 128) / 256 + 16);
+        cb[i] = (unsigned char) ((-38 * r -  74 * g + 112 * b + 128) / 256 + 128);
+        cr[i] = (unsigned char) ((112 * r -  94 * g -  18 * b + 128) / 256 + 128);
+    }
+}
+
+
+/* ========================================================================== */
+/*                          Threads de codificação                            */
+/* ========================================================================== */
+
+// Grava um quadro PNG no diretório de saída, numerado pelo seu ordinal.
+static bool
+write_png_file(const export_state_t& state, unsigned long frame,
+               const std::vector<unsigned char>& png)
+{
+    char filename[4096];
+    snprintf(filename, sizeof(filename), "%s/frame_%06lu.png",
+             state.options->path, frame);
+
+    FILE* fp = fopen(filename, "wb");
+    if(!fp) {
+        std::cerr << "Unable to open " << filename << " for writing."
+                  << std::endl;
+        return false;
+    }
+
+    bool ok = (fwrite(png.data(), 1, png.size(), fp) == png.size());
+    ok = (fclose(fp) == 0) && ok;
+    return ok;
+}
+
+// Grava um quadro Y4M no fluxo de saída. Como as threads terminam os quadros
+// fora de ordem, cada uma espera a vez do seu quadro antes de escrever.
+// A escrita em si ocorre fora da trava: apenas a thread da vez escreve, e a
+// fila de quadros permanece livre enquanto o leitor do pipe consome os dados.
+static bool
+write_y4m_frame(export_state_t& state, unsigned long frame,
+                const std::vector<unsigned char>& data)
+{
+    {
+        std::unique_lock<std::mutex> guard(state.lock);
+        state.next_turn.wait(guard, [&] {
+            return (state.next_write == frame) || state.failed;
+        });
+
+        if(state.failed) {
+            return false;
+        }
+    }
+
+    bool ok = (fwrite(data.data(), 1, data.size(), state.stream) == data.size());
+
+    std::lock_guard<std::mutex> guard(state.lock);
+    state.next_write++;
+    state.next_turn.notify_all();
+    return ok;
+}
+
+// Laço de cada thread de codificação: retira quadros da fila, rasteriza-os,
+// codifica-os e escreve-os, até que a fila seja encerrada.
+static void
+export_worker(export_state_t* state)
+{
+    const export_options_t& opt = *state->options;
+    const unsigned width  = AUTOMATON_WIDTH  * opt.scale;
+    const unsigned height = AUTOMATON_HEIGHT * opt.scale;
+
+    // Buffers reaproveitados entre quadros desta thread
+    std::vector<unsigned char> rgb, scratch, encoded;
+    export_job_t job;
+
+    while(true) {
+        {
+            std::unique_lock<std::mutex> guard(state->lock);
+            state->has_jobs.wait(guard, [&] {
+                return !state->queue.empty() || state->finished;
+            });
+
+            if(state->queue.empty()) {
+                return;
+            }
+
+            job = state->queue.front();
+            state->queue.pop_front();
+            state->has_room.notify_one();
+        }
+
+        if(state->failed) {
+            continue; // Apenas esvazia a fila
+        }
+
+        rasterize_frame(job, opt.scale, rgb);
+
+        bool ok;
+        if(opt.format == EXPORT_FORMAT_PNG) {
+            encode_png(rgb, width, height, scratch, encoded);
+            ok = write_png_file(*state, job.frame, encoded);
+        } else {
+            encode_y4m_frame(rgb, encoded);
+            ok = write_y4m_frame(*state, job.frame, encoded);
+        }
+
+        if(!ok) {
+            std::lock_guard<std::mutex> guard(state->lock);
+            state->failed = true;
+            state->next_turn.notify_all();
+            state->has_room.notify_all();
+        }
+    }
+}
+
+
+/* ========================================================================== */
+/*                           Loop de exportação                               */
+/* ========================================================================== */
+
+// Realiza os ciclos das gerações do autômato sem janela, exportando um quadro
+// a cada `options.every` gerações. A simulação corre na thread chamadora,
+// enquanto a rasterização e a codificação ocorrem em paralelo nas demais.
+// Retorna `false` caso a escrita de algum quadro falhe.
+bool
+automata_export_loop(const export_options_t& options)
+{
+    export_state_t state;
+    state.options    = &options;
+    state.stream     = NULL;
+    state.next_write = 0;
+    state.finished   = false;
+    state.failed     = false;
+
+    unsigned threads = options.threads;
+    if(threads == 0) {
+        // Deixa um núcleo livre para o loop de gerações.
+        unsigned cores = std::thread::hardware_concurrency();
+        threads = (cores > 1) ? (cores - 1) : 1;
+        threads = (threads > EXPORT_MAX_THREADS) ? EXPORT_MAX_THREADS : threads;
+    }
+    state.capacity = (size_t) threads * EXPORT_QUEUE_PER_THREAD;
+
+    if(options.format == EXPORT_FORMAT_PNG) {
+        init_crc_table();
+    } else {
+        if(!strcmp(options.path, "-")) {
+            state.stream = stdout;
+        } else {
+            // Um pipe nomeado também pode ser aberto desta forma.
+            state.stream = fopen(options.path, "wb");
+        }
+
+        if(!state.stream) {
+            std::cerr << "Unable to open " << options.path << " for writing."
+                      << std::endl;
+            return false;
+        }
+
+        fprintf(state.stream, "YUV4MPEG2 W%u H%u F30:1 Ip A1:1 C444\n",
+                AUTOMATON_WIDTH * options.scale,
+                AUTOMATON_HEIGHT * options.scale);
+    }
+
+    std::vector<std::thread> workers;
+    for(unsigned i = 0; i < threads; i++) {
+        workers.push_back(std::thread(export_worker, &state));
+    }
+
+    // Debug: coloca uma célula com estado excitado bem no centro, tal como
+    // no modo console.
+    cur_grid[AUTOMATON_HEIGHT / 2][AUTOMATON_WIDTH / 2] = CELL_EXCITED;
+
+    stream_publish(0);
+
+    unsigned long frame = 0;
+    for(unsigned long gen = 0; (gen < options.generations) && !state.failed;
+        gen++) {
+        if((gen % options.every) == 0) {
+            // Copia o estado atual fora da trava; a cópia é pequena e
+            // a simulação só espera caso a fila esteja cheia.
+            export_job_t job;
+            job.frame = frame++;
+            for(int i = 0; i < AUTOMATON_HEIGHT; i++) {
+                for(int j = 0; j < AUTOMATON_WIDTH; j++) {
+                    job.cells[i][j] = (unsigned char) cur_grid[i][j];
+                }
+            }
+
+            std::unique_lock<std::mutex> guard(state.lock);
+            state.has_room.wait(guard, [&] {
+                return (state.queue.size() < state.capacity) || state.failed;
+            });
+            state.queue.push_back(job);
+            state.has_jobs.notify_one();
+        }
+
+        copy_last_state();
+        apply_rules();
+        stream_publish(gen + 1);
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(state.lock);
+        state.finished = true;
+        state.has_jobs.notify_all();
+    }
+
+    for(size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+
+    if(state.stream) {
+        if(fflush(state.stream) != 0) {
+            state.failed = true;
+        }
+        if((state.stream != stdout) && (fclose(state.stream) != 0)) {
+            state.failed = true;
+        }
+    }
+
+    return !state.failed;
+}
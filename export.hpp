@@ -0,0 +1,28 @@
+#ifndef AUTOMATON_EXPORT_HPP
+#define AUTOMATON_EXPORT_HPP
+
+/* Este cabeçalho exporta a interface da exportação de quadros sem janela,
+ * utilizada pelo arquivo `main.cpp`. Para implementações e detalhes, veja
+ * `export.cpp`. */
+
+/* Formatos de saída suportados pela exportação */
+#define EXPORT_FORMAT_PNG 0
+#define EXPORT_FORMAT_Y4M 1
+
+/* Limites das opções numéricas da exportação */
+#define EXPORT_MAX_THREADS 64
+#define EXPORT_MAX_SCALE   64
+
+/* Opções da exportação, preenchidas a partir da linha de comando */
+struct export_options_t {
+    const char*   path;        // Diretório (PNG) ou arquivo/pipe (Y4M, "-")
+    int           format;      // Um dos EXPORT_FORMAT_*
+    unsigned long generations; // Quantidade de gerações a simular
+    unsigned long every;       // Exporta uma a cada `every` gerações
+    unsigned      threads;     // Threads de codificação (0 = automático)
+    unsigned      scale;       // Pixels por lado de cada célula
+};
+
+bool automata_export_loop(const export_options_t& options);
+
+#endif
@@ -10,6 +10,12 @@
 #define CELL_RECOVER 1
 #define CELL_EXCITED 2
 
+/* Cores de cada estado das células, como componentes RGB de 0 a 255.
+ * Compartilhadas entre a janela e a exportação de quadros. */
+#define CELL_RESTING_RGB   0,   0,   0
+#define CELL_RECOVER_RGB 128, 128, 128
+#define CELL_EXCITED_RGB 255, 255, 255
+
 /* Macros com definições para nomear direções */
 #define DIR_NORTH 0
 #define DIR_SOUTH 1
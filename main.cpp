@@ -1,5 +1,8 @@
 #include <iostream>
 #include <cstring>
+#include <cstdlib>
+#include <thread>
+#include <chrono>
 
 /* Cabeçalho com definições gerais para o autômato, compartilhadas
  * entre demais partes do programa. */
@@ -10,6 +13,13 @@
  * deste arquivo. */
 #include "window.hpp"
 
+/* Cabeçalho com definições da exportação de quadros sem janela. */
+#include "export.hpp"
+
+/* Cabeçalho com definições do servidor de transmissão para visualizadores
+ * remotos. */
+#include "stream.hpp"
+
 /* Grades do autômato, para um estado atual e um estado anterior */
 int cur_grid[AUTOMATON_HEIGHT][AUTOMATON_WIDTH];
 int old_grid[AUTOMATON_HEIGHT][AUTOMATON_WIDTH];
@@ -130,11 +140,15 @@ automata_console_loop()
 {
     // Debug: coloca uma célula com estado excitado bem no centro.
     cur_grid[AUTOMATON_HEIGHT / 2][AUTOMATON_WIDTH / 2] = CELL_EXCITED;
-    
+
+    unsigned long long generation = 0;
+    stream_publish(generation);
+
     while(true) {
         print_grid();
         copy_last_state();
         apply_rules();
+        stream_publish(++generation);
 
         // Interrupção: basta que o usuário digite 'q'.
         if(getchar() == 'q') {
@@ -143,6 +157,63 @@ automata_console_loop()
     }
 }
 
+/* Opções da exportação sem janela, preenchidas por `handle_args` */
+static export_options_t export_options = {
+    NULL, EXPORT_FORMAT_PNG, 1000, 1, 0, 8
+};
+
+/* Endereço do servidor de transmissão e intervalo entre gerações no modo sem
+ * janela, preenchidos por `handle_args` */
+static const char*   stream_address = NULL;
+static unsigned long step_interval  = 0;
+
+// Realiza os ciclos das gerações do autômato sem qualquer visualização local,
+// apenas transmitindo-as a visualizadores remotos. Com `--generations 0`, o
+// padrão neste modo, a simulação corre indefinidamente.
+static void
+automata_headless_loop()
+{
+    // Debug: coloca uma célula com estado excitado bem no centro.
+    cur_grid[AUTOMATON_HEIGHT / 2][AUTOMATON_WIDTH / 2] = CELL_EXCITED;
+
+    unsigned long long generation = 0;
+    stream_publish(generation);
+
+    while((export_options.generations == 0)
+          || (generation < export_options.generations)) {
+        copy_last_state();
+        apply_rules();
+        stream_publish(++generation);
+
+        if(step_interval > 0) {
+            std::this_thread::sleep_for(
+                std::chrono::milliseconds(step_interval));
+        }
+    }
+}
+
+// Interpreta o valor numérico do argumento na posição `i + 1`, caso exista,
+// avançando `i`. Retorna `false` se o valor estiver ausente ou for inválido.
+static bool
+parse_numeric_arg(int argc, char** argv, int& i, unsigned long& value)
+{
+    if(i + 1 >= argc) {
+        std::cerr << "Missing value for " << argv[i] << std::endl;
+        return false;
+    }
+
+    char* end = NULL;
+    value = strtoul(argv[i + 1], &end, 10);
+    if((*argv[i + 1] == '\0') || (*end != '\0') || (*argv[i + 1] == '-')) {
+        std::cerr << "Invalid value for " << argv[i] << ": "
+                  << argv[i + 1] << std::endl;
+        return false;
+    }
+
+    i++;
+    return true;
+}
+
 int
 handle_args(int argc, char** argv)
 {
@@ -150,8 +221,14 @@ handle_args(int argc, char** argv)
     // 0: A aplicação corre normalmente.
     // 1: A aplicação corre em console.
     // 2: A aplicação sai imediatamente.
+    // 3: A aplicação exporta quadros, sem janela.
+    // 4: A aplicação apenas transmite as gerações, sem janela.
+    // -1: Argumentos inválidos; a aplicação sai com erro.
 
-    bool nogui = false;
+    bool nogui           = false;
+    bool headless        = false;
+    bool generations_set = false;
+    unsigned long value;
 
     /*
      * Este loop tem duas funções:
@@ -165,6 +242,66 @@ handle_args(int argc, char** argv)
     for(int i = 1; i < argc; i++) {
         if(!strcmp(argv[i], "--nogui")) {
             nogui = true;
+        } else if(!strcmp(argv[i], "--export")) {
+            if(i + 1 >= argc) {
+                std::cerr << "Missing value for --export" << std::endl;
+                return -1;
+            }
+            export_options.path = argv[++i];
+        } else if(!strcmp(argv[i], "--export-format")) {
+            if((i + 1 < argc) && !strcmp(argv[i + 1], "png")) {
+                export_options.format = EXPORT_FORMAT_PNG;
+            } else if((i + 1 < argc) && !strcmp(argv[i + 1], "y4m")) {
+                export_options.format = EXPORT_FORMAT_Y4M;
+            } else {
+                std::cerr << "--export-format expects png or y4m" << std::endl;
+                return -1;
+            }
+            i++;
+        } else if(!strcmp(argv[i], "--export-every")) {
+            if(!parse_numeric_arg(argc, argv, i, value) || (value == 0)) {
+                return -1;
+            }
+            export_options.every = value;
+        } else if(!strcmp(argv[i], "--export-threads")) {
+            if(!parse_numeric_arg(argc, argv, i, value)) {
+                return -1;
+            }
+            if(value > EXPORT_MAX_THREADS) {
+                std::cerr << "--export-threads must be at most "
+                          << EXPORT_MAX_THREADS << std::endl;
+                return -1;
+            }
+            export_options.threads = (unsigned) value;
+        } else if(!strcmp(argv[i], "--export-scale")) {
+            if(!parse_numeric_arg(argc, argv, i, value)) {
+                return -1;
+            }
+            if((value == 0) || (value > EXPORT_MAX_SCALE)) {
+                std::cerr << "--export-scale must be between 1 and "
+                          << EXPORT_MAX_SCALE << std::endl;
+                return -1;
+            }
+            export_options.scale = (unsigned) value;
+        } else if(!strcmp(argv[i], "--stream")) {
+            if(i + 1 >= argc) {
+                std::cerr << "Missing value for --stream" << std::endl;
+                return -1;
+            }
+            stream_address = argv[++i];
+        } else if(!strcmp(argv[i], "--headless")) {
+            headless = true;
+        } else if(!strcmp(argv[i], "--step-interval")) {
+            if(!parse_numeric_arg(argc, argv, i, value)) {
+                return -1;
+            }
+            step_interval = value;
+        } else if(!strcmp(argv[i], "--generations")) {
+            if(!parse_numeric_arg(argc, argv, i, value)) {
+                return -1;
+            }
+            export_options.generations = value;
+            generations_set = true;
         } else if(!strcmp(argv[i], "--help")) {
             std::cout << "Greenber-Hastings Automaton"      << std::endl
                       << "Copyright (C) 2018 Lucas Vieira"  << std::endl
@@ -177,6 +314,42 @@ handle_args(int argc, char** argv)
                       << std::endl
                       << "\t--nogui          \tForce execution of automata on "
                       << "console."
+                      << std::endl
+                      << "\t--export PATH    \tRender frames without a window. "
+                      << "PATH is an existing" << std::endl
+                      << "\t                 \tdirectory for png, or a file, "
+                      << "pipe or - (stdout) for y4m."
+                      << std::endl
+                      << "\t--export-format F\tpng (default) or y4m."
+                      << std::endl
+                      << "\t--export-every K \tExport one frame every K "
+                      << "generations (default 1)."
+                      << std::endl
+                      << "\t--export-threads T\tEncoder threads, up to 64 "
+                      << "(default: one per spare core)."
+                      << std::endl
+                      << "\t--export-scale S \tPixels per cell side, up to 64 "
+                      << "(default 8)."
+                      << std::endl
+                      << "\t--generations N  \tGenerations to simulate when "
+                      << "exporting (default 1000)"
+                      << std::endl
+                      << "\t                 \tor headless (default 0, "
+                      << "which runs forever)."
+                      << std::endl
+                      << "\t--stream ADDR    \tBroadcast generations to remote "
+                      << "viewers. ADDR is a" << std::endl
+                      << "\t                 \tUnix socket path or tcp:PORT "
+                      << "(localhost only)."
+                      << std::endl
+                      << "\t--headless       \tStep without a window or "
+                      << "console output. Requires"
+                      << std::endl
+                      << "\t                 \t--stream; cannot be combined "
+                      << "with --export."
+                      << std::endl
+                      << "\t--step-interval MS\tDelay between headless "
+                      << "generations (default 0)."
                       << std::endl << std::endl
                 
                       << "Runtime GUI commands:" << std::endl
@@ -200,6 +373,29 @@ handle_args(int argc, char** argv)
         }
     }
 
+    if(headless) {
+        // Sem transmissão, o modo sem janela não teria o que mostrar; e a
+        // exportação já é, por si só, um modo sem janela.
+        if(!stream_address) {
+            std::cerr << "--headless requires --stream" << std::endl;
+            return -1;
+        } else if(export_options.path) {
+            std::cerr << "--headless cannot be combined with --export"
+                      << std::endl;
+            return -1;
+        }
+
+        // Um servidor de transmissão corre, por padrão, indefinidamente.
+        if(!generations_set) {
+            export_options.generations = 0;
+        }
+        return 4;
+    }
+
+    if(export_options.path) {
+        return 3;
+    }
+
     if(nogui) {
         return 1;
     }
@@ -219,12 +415,28 @@ main(int argc, char** argv)
         // A opção '2' indica que o texto de ajuda foi impresso e,
         // portanto, o programa se encerra em seguida.
         return 0;
+    } else if(arg_handler == -1) {
+        // Argumentos inválidos já foram reportados por `handle_args`.
+        return 1;
+    }
+
+    // Inicializa o servidor de transmissão, se requisitado
+    if(stream_address && !stream_start(stream_address)) {
+        return 1;
     }
 
     // Inicializa o autômato
     initialize_automata();
 
-    if((arg_handler == 1) || !create_window()) {
+    int status = 0;
+
+    if(arg_handler == 3) {
+        // A exportação não depende de janela e encerra o programa ao fim.
+        status = automata_export_loop(export_options) ? 0 : 1;
+    } else if(arg_handler == 4) {
+        // O modo sem janela apenas alimenta o servidor de transmissão.
+        automata_headless_loop();
+    } else if((arg_handler == 1) || !create_window()) {
         // Em caso de indicador de modo console ou falha ao criar a janela,
         // dê fallback para o modo texto
         automata_console_loop();
@@ -232,6 +444,7 @@ main(int argc, char** argv)
         // Caso contrário, execute a aplicação normalmente
         automata_gui_loop();
     }
-    
-    return 0;
+
+    stream_stop();
+    return status;
 }
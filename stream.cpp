@@ -0,0 +1,746 @@
+#include "macros.hpp"
+#include "stream.hpp"
+#include <iostream>
+
+/* ========================================================================== */
+/*                              Variáveis externas                            */
+/* ========================================================================== */
+
+// A variável a seguir foi declarada em `main.cpp`.
+
+// Provê acesso externo ao estado atual do autômato.
+extern int cur_grid[AUTOMATON_HEIGHT][AUTOMATON_WIDTH];
+
+#ifdef _WIN32
+
+/* O servidor depende de sockets POSIX; no Windows, apenas avisamos. */
+
+bool
+stream_start(const char* address)
+{
+    std::cerr << "Streaming is not supported on this platform." << std::endl;
+    return false;
+}
+
+void stream_publish(unsigned long long generation) {}
+void stream_stop() {}
+
+#else
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/* ========================================================================== */
+/*                           Formato das mensagens                            */
+/* ========================================================================== */
+
+/* Cada mensagem enviada aos clientes é composta por um cabeçalho de 32 bytes,
+ * com inteiros em little-endian:
+ *
+ *   u8  tipo ('K': quadro-chave; 'D': delta)
+ *   u8  reservado[3]
+ *   u32 tamanho do conteúdo, em bytes
+ *   u64 geração descrita pela mensagem
+ *   u64 última geração publicada no momento do envio
+ *   u64 instante da publicação da geração, em microssegundos desde a época
+ *       Unix; como o servidor só aceita conexões locais, o cliente pode
+ *       compará-lo ao próprio relógio para medir o atraso
+ *
+ * O conteúdo de um quadro-chave é `u16 largura, u16 altura`, seguido pelo
+ * estado completo da grade codificado em RLE, como pares `u16 quantidade,
+ * u8 estado`, percorrendo as células linha a linha.
+ *
+ * O conteúdo de um delta descreve apenas as células que mudaram desde a
+ * geração anterior, como blocos `u16 células inalteradas, u16 quantidade`,
+ * seguidos de `quantidade` bytes com os novos estados.
+ *
+ * Um cliente sempre recebe primeiro um quadro-chave: logo ao se conectar, o
+ * da última geração publicada, se houver, e outro junto da próxima geração.
+ * Deltas subsequentes são consecutivos; se algum precisar ser descartado, o
+ * próximo envio para aquele cliente é um novo quadro-chave.
+ *
+ * No sentido inverso, o cliente confirma cada mensagem aplicada enviando um
+ * `u64` com a sua geração. Um cliente que confirme mais mensagens do que
+ * recebeu é desconectado. Isto limita a quantidade de mensagens em trânsito,
+ * inclusive nos buffers do kernel: um cliente com STREAM_BACKLOG mensagens
+ * não confirmadas deixa de recebê-las até confirmar alguma, quando então
+ * recebe um novo quadro-chave da geração corrente. */
+
+#define STREAM_FRAME_KEY   'K'
+#define STREAM_FRAME_DELTA 'D'
+#define STREAM_HEADER_SIZE 32
+
+/* Quantidade máxima de clientes simultâneos */
+#define STREAM_MAX_CLIENTS 16
+
+/* Mensagens não confirmadas por cliente. Como uma mensagem só é confirmada
+ * depois de enviada, este é também o tamanho suficiente da fila circular. */
+#define STREAM_BACKLOG     4
+
+/* Uma mensagem já codificada, compartilhada entre todos os clientes */
+struct stream_frame_t {
+    unsigned char              type;
+    unsigned long long         generation;
+    unsigned long long         published_us;
+    std::vector<unsigned char> payload;
+};
+
+typedef std::shared_ptr<const stream_frame_t> stream_frame_ptr;
+
+/* Estados de uma posição da tabela de clientes */
+enum {
+    SLOT_FREE,    // Livre para um novo cliente
+    SLOT_CLAIMED, // Sendo preparada pela thread de conexões
+    SLOT_ACTIVE,  // Recebendo mensagens
+    SLOT_CLOSED   // Cliente desconectado; pode ser reaproveitada
+};
+
+/* Um cliente conectado. A fila circular tem um único produtor (o loop de
+ * gerações, via `stream_publish`) e um único consumidor (a thread de envio do
+ * cliente), de forma que nenhuma trava é necessária: o produtor apenas avança
+ * `head`, e o consumidor apenas avança `tail` e `acked`. Quando a fila estava
+ * vazia, o produtor acorda a thread de envio escrevendo um byte em `wake`.
+ * O socket pertence à thread de envio, que o fecha ao sair. */
+struct stream_client_t {
+    std::atomic<int>                state;
+    std::atomic<bool>               busy;   // Produtor acessando a posição
+    int                             fd;
+    int                             wake[2];
+    std::thread                     sender;
+    stream_frame_ptr                ring[STREAM_BACKLOG];
+    std::atomic<unsigned long long> head;   // Mensagens enfileiradas
+    std::atomic<unsigned long long> tail;   // Mensagens enviadas
+    std::atomic<unsigned long long> acked;  // Mensagens confirmadas
+    bool                            resync; // Usado apenas pelo produtor
+};
+
+/* Estado global do servidor, inacessível em outros arquivos */
+static stream_client_t                 clients[STREAM_MAX_CLIENTS];
+static std::thread                     acceptor;
+static std::atomic<bool>               running(false);
+static std::atomic<unsigned long long> latest_generation(0);
+static int                             listen_fd = -1;
+static std::string                     unix_path;
+
+/* Último estado publicado, base para o cálculo dos deltas */
+static unsigned char last_grid[AUTOMATON_HEIGHT * AUTOMATON_WIDTH];
+static bool          has_last_grid = false;
+
+/* Quadro-chave da última geração publicada, enviado de imediato a novos
+ * clientes. Acessado apenas por `std::atomic_load` e `std::atomic_store`. */
+static stream_frame_ptr latest_key;
+
+
+/* ========================================================================== */
+/*                           Codificação das mensagens                        */
+/* ========================================================================== */
+
+static void
+put_u16_le(std::vector<unsigned char>& out, unsigned value)
+{
+    out.push_back(value & 0xFF);
+    out.push_back((value >> 8) & 0xFF);
+}
+
+static void
+put_u64_le(unsigned char* out, unsigned long long value)
+{
+    for(int i = 0; i < 8; i++) {
+        out[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+// Codifica o estado completo `grid` como um quadro-chave.
+static stream_frame_ptr
+encode_keyframe(const unsigned char* grid, unsigned long long generation,
+                unsigned long long published_us)
+{
+    std::shared_ptr<stream_frame_t> frame(new stream_frame_t);
+    frame->type         = STREAM_FRAME_KEY;
+    frame->generation   = generation;
+    frame->published_us = published_us;
+
+    std::vector<unsigned char>& out = frame->payload;
+    put_u16_le(out, AUTOMATON_WIDTH);
+    put_u16_le(out, AUTOMATON_HEIGHT);
+
+    const int cells = AUTOMATON_HEIGHT * AUTOMATON_WIDTH;
+    int i = 0;
+    while(i < cells) {
+        int run = 1;
+        while((i + run < cells) && (run < 0xFFFF)
+              && (grid[i + run] == grid[i])) {
+            run++;
+        }
+        put_u16_le(out, run);
+        out.push_back(grid[i]);
+        i += run;
+    }
+
+    return frame;
+}
+
+// Codifica as diferenças entre `last_grid` e `grid` como um delta.
+static stream_frame_ptr
+encode_delta(const unsigned char* grid, unsigned long long generation,
+             unsigned long long published_us)
+{
+    std::shared_ptr<stream_frame_t> frame(new stream_frame_t);
+    frame->type         = STREAM_FRAME_DELTA;
+    frame->generation   = generation;
+    frame->published_us = published_us;
+
+    std::vector<unsigned char>& out = frame->payload;
+    const int cells = AUTOMATON_HEIGHT * AUTOMATON_WIDTH;
+    int i = 0;
+    while(i < cells) {
+        // Conta as células inalteradas...
+        int skip = 0;
+        while((i + skip < cells) && (skip < 0xFFFF)
+              && (grid[i + skip] == last_grid[i + skip])) {
+            skip++;
+        }
+        i += skip;
+
+        // ...e, em seguida, as alteradas.
+        int run = 0;
+        while((i + run < cells) && (run < 0xFFFF)
+              && (grid[i + run] != last_grid[i + run])) {
+            run++;
+        }
+
+        if(run == 0 && i == cells) {
+            break; // O restante da grade não mudou
+        }
+
+        put_u16_le(out, skip);
+        put_u16_le(out, run);
+        out.insert(out.end(), grid + i, grid + i + run);
+        i += run;
+    }
+
+    return frame;
+}
+
+
+/* ========================================================================== */
+/*                             Threads do servidor                            */
+/* ========================================================================== */
+
+// Envia todo o buffer, lidando com escritas parciais. O socket não bloqueia,
+// de forma que a thread possa perceber o encerramento do servidor mesmo com
+// um cliente que parou de ler. Retorna `false` se o cliente se desconectou ou
+// se o servidor está sendo encerrado.
+static bool
+send_all(int fd, const unsigned char* data, size_t len)
+{
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+
+    while(len > 0) {
+        ssize_t sent = send(fd, data, len, flags);
+        if(sent > 0) {
+            data += sent;
+            len  -= (size_t) sent;
+        } else if((sent < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)
+                                 || (errno == EINTR))) {
+            if(!running) {
+                return false;
+            }
+            struct pollfd pfd = { fd, POLLOUT, 0 };
+            poll(&pfd, 1, 100);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Lê, sem bloquear, as confirmações enviadas pelo cliente. `filled` conta os
+// bytes de uma confirmação recebida parcialmente, e `acks` o total de
+// confirmações. Como cada confirmação corresponde a uma mensagem, um cliente
+// que confirme mais do que as `sent` mensagens enviadas viola o protocolo.
+// Retorna `false` se o cliente se desconectou ou deve ser desconectado.
+static bool
+read_acks(int fd, unsigned char* ack, size_t& filled,
+          unsigned long long& acks, unsigned long long sent)
+{
+    while(true) {
+        ssize_t got = recv(fd, ack + filled, 8 - filled, MSG_DONTWAIT);
+        if(got == 0) {
+            return false;
+        } else if(got < 0) {
+            return (errno == EAGAIN) || (errno == EWOULDBLOCK)
+                || (errno == EINTR);
+        }
+
+        filled += (size_t) got;
+        if(filled == 8) {
+            filled = 0;
+            if(++acks > sent) {
+                std::cerr << "Stream: client acknowledged unsent messages, "
+                          << "disconnecting." << std::endl;
+                return false;
+            }
+        }
+    }
+}
+
+// Envia uma mensagem ao cliente, precedida pelo seu cabeçalho.
+static bool
+send_frame(int fd, const stream_frame_t& frame,
+           std::vector<unsigned char>& buffer)
+{
+    const uint32_t size = (uint32_t) frame.payload.size();
+    buffer.assign(STREAM_HEADER_SIZE, 0);
+    buffer[0] = frame.type;
+    buffer[4] = size & 0xFF;
+    buffer[5] = (size >> 8) & 0xFF;
+    buffer[6] = (size >> 16) & 0xFF;
+    buffer[7] = (size >> 24) & 0xFF;
+    put_u64_le(&buffer[8],  frame.generation);
+    put_u64_le(&buffer[16], latest_generation.load());
+    put_u64_le(&buffer[24], frame.published_us);
+    buffer.insert(buffer.end(), frame.payload.begin(), frame.payload.end());
+
+    return send_all(fd, buffer.data(), buffer.size());
+}
+
+// Laço da thread de envio de um cliente. A thread dorme em `poll` até que o
+// produtor enfileire uma mensagem ou o cliente envie uma confirmação. Um
+// cliente lento bloqueia apenas esta thread; enquanto isso, suas confirmações
+// atrasam e o produtor passa a descartar mensagens para ele, até poder enviar
+// um novo quadro-chave.
+static void
+stream_sender(stream_client_t* client)
+{
+    std::vector<unsigned char> buffer;
+    unsigned char      ack[8];
+    size_t             ack_filled = 0;
+    unsigned long long acks       = 0;
+    unsigned long long direct     = 0; // Mensagens enviadas fora da fila
+    bool               connected  = true;
+
+    // Descarta despertares que tenham sobrado do cliente anterior.
+    unsigned char drain[64];
+    while(read(client->wake[0], drain, sizeof(drain)) > 0) {}
+
+    // O cliente recebe de imediato o último estado publicado, mesmo que o
+    // loop de gerações esteja parado (console aguardando entrada, janela
+    // pausada). A fila continua começando por um quadro-chave.
+    stream_frame_ptr initial = std::atomic_load(&latest_key);
+    if(initial) {
+        connected = send_frame(client->fd, *initial, buffer);
+        direct = 1;
+    }
+
+    while(connected && running) {
+        // Envia tudo o que estiver na fila. A mensagem é retirada antes do
+        // envio, liberando a posição para o produtor o quanto antes.
+        unsigned long long tail = client->tail.load(std::memory_order_relaxed);
+        while(connected && (tail != client->head.load())) {
+            stream_frame_ptr frame;
+            frame.swap(client->ring[tail % STREAM_BACKLOG]);
+            client->tail.store(++tail);
+            connected = send_frame(client->fd, *frame, buffer);
+        }
+
+        if(!connected) {
+            break;
+        }
+
+        struct pollfd pfd[2] = {
+            { client->fd,      POLLIN, 0 },
+            { client->wake[0], POLLIN, 0 }
+        };
+        if(poll(pfd, 2, 100) <= 0) {
+            continue;
+        }
+
+        if(pfd[1].revents & POLLIN) {
+            while(read(client->wake[0], drain, sizeof(drain)) > 0) {}
+        }
+
+        if(pfd[0].revents) {
+            connected = read_acks(client->fd, ack, ack_filled, acks,
+                                  tail + direct);
+
+            // A primeira confirmação corresponde à mensagem inicial, que
+            // não passou pela fila.
+            if(acks > direct) {
+                client->acked.store(acks - direct, std::memory_order_release);
+            }
+        }
+    }
+
+    // O socket pertence a esta thread; a posição será reaproveitada pela
+    // thread de conexões.
+    close(client->fd);
+    client->fd = -1;
+    client->state.store(SLOT_CLOSED);
+}
+
+// Acorda a thread de envio de um cliente. O pipe não bloqueia; se estiver
+// cheio, a thread já tem um despertar pendente.
+static void
+wake_sender(stream_client_t& client)
+{
+    const unsigned char byte = 0;
+    ssize_t ignored = write(client.wake[1], &byte, 1);
+    (void) ignored;
+}
+
+// Reserva uma posição livre, ou de um cliente já desconectado, para um novo
+// cliente. Retorna NULL se todas estiverem ocupadas.
+static stream_client_t*
+claim_slot()
+{
+    for(int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        stream_client_t& client = clients[i];
+        int expected = SLOT_FREE;
+        if(!client.state.compare_exchange_strong(expected, SLOT_CLAIMED)) {
+            expected = SLOT_CLOSED;
+            if(!client.state.compare_exchange_strong(expected,
+                                                     SLOT_CLAIMED)) {
+                continue;
+            }
+        }
+
+        // O produtor pode ter lido o estado anterior e ainda estar usando a
+        // posição; esperamos que ele a solte. Veja `stream_publish`.
+        while(client.busy.load()) {
+            std::this_thread::yield();
+        }
+
+        // Recolhe a thread do cliente anterior, que já está saindo.
+        if(client.sender.joinable()) {
+            client.sender.join();
+        }
+
+        for(int k = 0; k < STREAM_BACKLOG; k++) {
+            client.ring[k].reset();
+        }
+        client.head   = 0;
+        client.tail   = 0;
+        client.acked  = 0;
+        client.resync = true;
+        return &client;
+    }
+    return NULL;
+}
+
+// Laço da thread de conexões: aceita novos clientes e os associa a posições
+// livres da tabela.
+static void
+stream_acceptor()
+{
+    while(running) {
+        struct pollfd pfd = { listen_fd, POLLIN, 0 };
+        if(poll(&pfd, 1, 100) <= 0) {
+            continue;
+        }
+
+        int fd = accept(listen_fd, NULL, NULL);
+        if(fd < 0) {
+            continue;
+        }
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+        stream_client_t* client = claim_slot();
+        if(!client) {
+            std::cerr << "Stream: too many clients, refusing connection."
+                      << std::endl;
+            close(fd);
+            continue;
+        }
+
+        client->fd     = fd;
+        client->sender = std::thread(stream_sender, client);
+        client->state.store(SLOT_ACTIVE);
+    }
+}
+
+// Remove um socket Unix que tenha sobrado de uma execução anterior. Qualquer
+// outro tipo de arquivo no caminho é preservado. Retorna `false` se o caminho
+// estiver ocupado por algo que não seja um socket.
+static bool
+remove_stale_socket(const char* path)
+{
+    struct stat info;
+    if(lstat(path, &info) < 0) {
+        return errno == ENOENT;
+    }
+
+    if(!S_ISSOCK(info.st_mode)) {
+        std::cerr << path << " exists and is not a socket." << std::endl;
+        return false;
+    }
+
+    return unlink(path) == 0;
+}
+
+// Cria o socket de escuta. Endereços da forma `tcp:PORTA` escutam apenas em
+// 127.0.0.1; qualquer outro é tratado como caminho de um socket Unix.
+static int
+open_listener(const char* address)
+{
+    int fd;
+
+    if(!strncmp(address, "tcp:", 4)) {
+        char* end = NULL;
+        long port = strtol(address + 4, &end, 10);
+        if((*end != '\0') || (port <= 0) || (port > 65535)) {
+            std::cerr << "Invalid stream port: " << address + 4 << std::endl;
+            return -1;
+        }
+
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if(fd < 0) {
+            return -1;
+        }
+
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family      = AF_INET;
+        addr.sin_port        = htons((unsigned short) port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if(bind(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+            close(fd);
+            return -1;
+        }
+    } else {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if(strlen(address) >= sizeof(addr.sun_path)) {
+            std::cerr << "Stream socket path is too long." << std::endl;
+            return -1;
+        }
+        strcpy(addr.sun_path, address);
+
+        if(!remove_stale_socket(address)) {
+            return -1;
+        }
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(fd < 0) {
+            return -1;
+        }
+
+        if(bind(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+            close(fd);
+            return -1;
+        }
+        unix_path = address;
+    }
+
+    if(listen(fd, STREAM_MAX_CLIENTS) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+
+/* ========================================================================== */
+/*                             Funções exportadas                             */
+/* ========================================================================== */
+
+// Inicia o servidor no endereço informado. Retorna `false` em caso de falha.
+bool
+stream_start(const char* address)
+{
+    listen_fd = open_listener(address);
+    if(listen_fd < 0) {
+        std::cerr << "Unable to listen on " << address << std::endl;
+        return false;
+    }
+
+    // Cada posição tem um pipe de despertar próprio, mantido por toda a
+    // execução do servidor.
+    for(int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        stream_client_t& client = clients[i];
+        if(pipe(client.wake) < 0) {
+            std::cerr << "Unable to create stream wake pipe." << std::endl;
+            for(int k = 0; k < i; k++) {
+                close(clients[k].wake[0]);
+                close(clients[k].wake[1]);
+            }
+            close(listen_fd);
+            listen_fd = -1;
+            return false;
+        }
+        fcntl(client.wake[0], F_SETFL, O_NONBLOCK);
+        fcntl(client.wake[1], F_SETFL, O_NONBLOCK);
+
+        client.state  = SLOT_FREE;
+        client.busy   = false;
+        client.fd     = -1;
+        client.head   = 0;
+        client.tail   = 0;
+        client.acked  = 0;
+        client.resync = true;
+    }
+
+    running  = true;
+    acceptor = std::thread(stream_acceptor);
+    return true;
+}
+
+// Publica o estado atual do autômato para todos os clientes. Esta função é
+// chamada pelo loop de gerações e nunca bloqueia: se um cliente tiver
+// mensagens demais sem confirmação, a mensagem é descartada para ele e
+// substituída, assim que ele confirmar alguma, por um quadro-chave.
+void
+stream_publish(unsigned long long generation)
+{
+    if(!running) {
+        return;
+    }
+
+    unsigned char grid[AUTOMATON_HEIGHT * AUTOMATON_WIDTH];
+    for(int i = 0; i < AUTOMATON_HEIGHT; i++) {
+        for(int j = 0; j < AUTOMATON_WIDTH; j++) {
+            grid[i * AUTOMATON_WIDTH + j] = (unsigned char) cur_grid[i][j];
+        }
+    }
+
+    latest_generation.store(generation);
+
+    const unsigned long long published_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // O quadro-chave é codificado a cada geração, pois é também a mensagem
+    // inicial de novos clientes; o delta, apenas se algum cliente precisar.
+    stream_frame_ptr key = encode_keyframe(grid, generation, published_us);
+    stream_frame_ptr delta;
+    std::atomic_store(&latest_key, key);
+
+    for(int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        stream_client_t& client = clients[i];
+
+        // `busy` sinaliza à thread de conexões que esta posição está em uso.
+        // As operações sequencialmente consistentes em `busy` e `state`,
+        // aqui e em `claim_slot`, garantem que a posição não seja
+        // reaproveitada no meio deste acesso.
+        client.busy.store(true);
+        if(client.state.load() != SLOT_ACTIVE) {
+            client.busy.store(false);
+            continue;
+        }
+
+        // Um cliente que não confirmou as últimas mensagens está atrasado e
+        // precisará de um quadro-chave. Como `acked <= tail <= head`, isto
+        // também garante que há espaço na fila.
+        unsigned long long head = client.head.load(std::memory_order_relaxed);
+        if(head - client.acked.load(std::memory_order_acquire)
+           >= STREAM_BACKLOG) {
+            client.resync = true;
+            client.busy.store(false);
+            continue;
+        }
+
+        stream_frame_ptr frame;
+        if(client.resync || !has_last_grid) {
+            frame = key;
+            client.resync = false;
+        } else {
+            if(!delta) {
+                delta = encode_delta(grid, generation, published_us);
+            }
+            frame = delta;
+        }
+
+        client.ring[head % STREAM_BACKLOG] = frame;
+        client.head.store(head + 1);
+
+        // Se a thread de envio já tinha esvaziado a fila, ela pode estar
+        // dormindo. As operações sequencialmente consistentes em `head` e
+        // `tail`, aqui e em `stream_sender`, garantem que ao menos um dos
+        // lados perceba a nova mensagem.
+        if(client.tail.load() == head) {
+            wake_sender(client);
+        }
+
+        client.busy.store(false);
+    }
+
+    memcpy(last_grid, grid, sizeof(grid));
+    has_last_grid = true;
+}
+
+// Encerra o servidor, desconectando todos os clientes.
+void
+stream_stop()
+{
+    if(!running) {
+        return;
+    }
+
+    running = false;
+    acceptor.join();
+
+    for(int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        stream_client_t& client = clients[i];
+
+        // A thread de envio percebe o encerramento em até 100ms, ou de
+        // imediato se estiver dormindo em `poll`, e fecha o próprio socket.
+        wake_sender(client);
+        if(client.sender.joinable()) {
+            client.sender.join();
+        }
+
+        close(client.wake[0]);
+        close(client.wake[1]);
+        client.wake[0] = -1;
+        client.wake[1] = -1;
+
+        for(int k = 0; k < STREAM_BACKLOG; k++) {
+            client.ring[k].reset();
+        }
+        client.state = SLOT_FREE;
+    }
+
+    std::atomic_store(&latest_key, stream_frame_ptr());
+
+    close(listen_fd);
+    listen_fd = -1;
+
+    if(!unix_path.empty()) {
+        unlink(unix_path.c_str());
+        unix_path.clear();
+    }
+}
+
+#endif
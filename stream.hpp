@@ -0,0 +1,12 @@
+#ifndef AUTOMATON_STREAM_HPP
+#define AUTOMATON_STREAM_HPP
+
+/* Este cabeçalho exporta a interface do servidor de transmissão do estado
+ * do autômato para visualizadores remotos. Para implementações, detalhes e
+ * o formato das mensagens, veja `stream.cpp`. */
+
+bool stream_start(const char* address);
+void stream_publish(unsigned long long generation);
+void stream_stop();
+
+#endif
@@ -0,0 +1,274 @@
+/* Cliente de referência para o servidor de transmissão do autômato.
+ *
+ * Conecta-se ao endereço informado (caminho de socket Unix ou `tcp:PORTA`),
+ * reconstrói a grade a partir dos quadros-chave e deltas recebidos e reporta,
+ * uma vez por segundo, a geração atual e o atraso com relação ao servidor,
+ * medido entre a publicação da geração e a sua aplicação no cliente.
+ * Cada mensagem aplicada é confirmada ao servidor. O formato das mensagens
+ * está descrito em `stream.cpp`.
+ *
+ * Uso: stream_client ENDEREÇO [--delay MS]
+ *
+ * A opção `--delay` faz o cliente dormir após cada mensagem, simulando um
+ * visualizador lento, para observar a ressincronização por quadros-chave. */
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define STREAM_HEADER_SIZE 32
+
+/* Estado reconstruído da grade, tal como visto pelo cliente */
+struct client_grid_t {
+    unsigned                   width;
+    unsigned                   height;
+    std::vector<unsigned char> cells;
+    unsigned long long         generation;
+    bool                       synced;
+};
+
+// Conecta-se ao servidor. Retorna o descritor do socket, ou -1.
+static int
+connect_to(const char* address)
+{
+    int fd;
+
+    if(!strncmp(address, "tcp:", 4)) {
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family      = AF_INET;
+        addr.sin_port        = htons((unsigned short) atoi(address + 4));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if((fd >= 0) && (connect(fd, (struct sockaddr*) &addr,
+                                 sizeof(addr)) < 0)) {
+            close(fd);
+            fd = -1;
+        }
+    } else {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, address, sizeof(addr.sun_path) - 1);
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if((fd >= 0) && (connect(fd, (struct sockaddr*) &addr,
+                                 sizeof(addr)) < 0)) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    return fd;
+}
+
+// Lê exatamente `len` bytes. Retorna `false` se a conexão foi encerrada.
+static bool
+recv_all(int fd, unsigned char* data, size_t len)
+{
+    while(len > 0) {
+        ssize_t got = recv(fd, data, len, 0);
+        if(got <= 0) {
+            return false;
+        }
+        data += got;
+        len  -= (size_t) got;
+    }
+    return true;
+}
+
+static unsigned
+get_u16_le(const unsigned char* p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static unsigned long long
+get_u64_le(const unsigned char* p)
+{
+    unsigned long long value = 0;
+    for(int i = 7; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+// Substitui a grade pelo conteúdo de um quadro-chave.
+static bool
+apply_keyframe(client_grid_t& grid, const std::vector<unsigned char>& payload)
+{
+    if(payload.size() < 4) {
+        return false;
+    }
+
+    grid.width  = get_u16_le(&payload[0]);
+    grid.height = get_u16_le(&payload[2]);
+    grid.cells.clear();
+
+    for(size_t i = 4; i + 3 <= payload.size(); i += 3) {
+        grid.cells.insert(grid.cells.end(), get_u16_le(&payload[i]),
+                          payload[i + 2]);
+    }
+
+    return grid.cells.size() == (size_t) grid.width * grid.height;
+}
+
+// Aplica as células alteradas de um delta sobre a grade.
+static bool
+apply_delta(client_grid_t& grid, const std::vector<unsigned char>& payload)
+{
+    size_t cell = 0, i = 0;
+    while(i + 4 <= payload.size()) {
+        cell += get_u16_le(&payload[i]);
+        unsigned run = get_u16_le(&payload[i + 2]);
+        i += 4;
+
+        if((i + run > payload.size()) || (cell + run > grid.cells.size())) {
+            return false;
+        }
+        memcpy(&grid.cells[cell], &payload[i], run);
+        cell += run;
+        i    += run;
+    }
+    return i == payload.size();
+}
+
+// Retorna o instante atual, em microssegundos desde a época Unix, tal como
+// o servidor marca a publicação de cada geração.
+static unsigned long long
+now_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Conta as células excitadas, como um resumo simples da grade reconstruída.
+static size_t
+count_excited(const client_grid_t& grid)
+{
+    size_t excited = 0;
+    for(size_t i = 0; i < grid.cells.size(); i++) {
+        excited += (grid.cells[i] == 2);
+    }
+    return excited;
+}
+
+int
+main(int argc, char** argv)
+{
+    if(argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " ADDRESS [--delay MS]"
+                  << std::endl;
+        return 1;
+    }
+
+    unsigned delay = 0;
+    if((argc >= 4) && !strcmp(argv[2], "--delay")) {
+        delay = (unsigned) atoi(argv[3]);
+    }
+
+    int fd = connect_to(argv[1]);
+    if(fd < 0) {
+        std::cerr << "Unable to connect to " << argv[1] << std::endl;
+        return 1;
+    }
+
+    client_grid_t grid = { 0, 0, std::vector<unsigned char>(), 0, false };
+    unsigned char header[STREAM_HEADER_SIZE];
+    std::vector<unsigned char> payload;
+
+    unsigned long long frames = 0, keyframes = 0, bytes = 0, latest = 0;
+    unsigned long long published = 0, lag_us = 0;
+    auto last_report = std::chrono::steady_clock::now();
+
+    while(recv_all(fd, header, STREAM_HEADER_SIZE)) {
+        uint32_t size = header[4] | (header[5] << 8) | (header[6] << 16)
+            | ((uint32_t) header[7] << 24);
+        unsigned long long generation = get_u64_le(&header[8]);
+        latest    = get_u64_le(&header[16]);
+        published = get_u64_le(&header[24]);
+
+        payload.resize(size);
+        if((size > 0) && !recv_all(fd, payload.data(), size)) {
+            break;
+        }
+
+        bool ok;
+        if(header[0] == 'K') {
+            ok = apply_keyframe(grid, payload);
+            grid.synced = ok;
+            keyframes++;
+        } else if(header[0] == 'D') {
+            // Deltas só fazem sentido sobre a geração imediatamente anterior.
+            ok = grid.synced && (generation == grid.generation + 1)
+                && apply_delta(grid, payload);
+        } else {
+            ok = false;
+        }
+
+        if(!ok) {
+            std::cerr << "Protocol error at generation " << generation
+                      << std::endl;
+            close(fd);
+            return 1;
+        }
+
+        grid.generation = generation;
+        frames++;
+
+        // O atraso é o tempo entre a publicação da geração no servidor e a
+        // sua aplicação aqui, incluindo o tempo parado em buffers.
+        unsigned long long now = now_us();
+        lag_us = (now > published) ? (now - published) : 0;
+
+        // Confirma a geração aplicada, liberando o envio das próximas.
+        unsigned char ack[8];
+        for(int i = 0; i < 8; i++) {
+            ack[i] = (generation >> (8 * i)) & 0xFF;
+        }
+#ifdef MSG_NOSIGNAL
+        const int flags = MSG_NOSIGNAL;
+#else
+        const int flags = 0;
+#endif
+        if(send(fd, ack, sizeof(ack), flags) != (ssize_t) sizeof(ack)) {
+            break;
+        }
+        bytes += STREAM_HEADER_SIZE + size;
+
+        auto tick = std::chrono::steady_clock::now();
+        if(tick - last_report >= std::chrono::seconds(1)) {
+            last_report = tick;
+
+            std::cout << "generation " << grid.generation
+                      << "  server " << latest
+                      << "  lag " << (lag_us / 1000.0) << " ms"
+                      << "  frames " << frames
+                      << "  keyframes " << keyframes
+                      << "  bytes " << bytes
+                      << "  excited " << count_excited(grid) << std::endl;
+        }
+
+        if(delay > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+        }
+    }
+
+    std::cout << "Disconnected at generation " << grid.generation
+              << " (server at " << latest << "), " << frames << " frames, "
+              << keyframes << " keyframes, " << count_excited(grid)
+              << " excited cells." << std::endl;
+
+    close(fd);
+    return 0;
+}
@@ -1,5 +1,6 @@
 #include "macros.hpp"
 #include "window.hpp"
+#include "stream.hpp"
 #include <GLFW/glfw3.h>
 #include <cstring>
 
@@ -39,17 +40,18 @@ struct user_input_t {
 
 /* Valores relacionados a instâncias da janela */
 struct window_info_t {
-    GLFWwindow* ptr;
-    double      width;
-    double      height;
-    double      last_swap;
-    double      refresh_interval;
+    GLFWwindow*        ptr;
+    double             width;
+    double             height;
+    double             last_swap;
+    double             refresh_interval;
+    unsigned long long generation;
 };
 
 
 /* Instâncias das estruturas acima, inacessíveis em outros arquivos */
 static user_input_t  input  = {};
-static window_info_t window = { NULL, 640.0, 640.0, 0.0, 0.025 };
+static window_info_t window = { NULL, 640.0, 640.0, 0.0, 0.025, 0 };
 
 
 /* ========================================================================== */
@@ -117,8 +119,10 @@ create_window()
     // Força a utilização do contexto OpenGL na thread principal do programa
     glfwMakeContextCurrent(window.ptr);
 
-    // Altera a cor de fundo do contexto
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    // Altera a cor de fundo do contexto para a cor das células em repouso
+    const unsigned char resting[3] = { CELL_RESTING_RGB };
+    glClearColor(resting[0] / 255.0f, resting[1] / 255.0f,
+                 resting[2] / 255.0f, 1.0f);
 
     // Redefine a posição inicial da matriz de projeção. Equivale a uma chamada
     // do callback de redimensionamento, então... chamamos ele logo.
@@ -181,6 +185,9 @@ automata_gui_update()
             // Aplica as regras no autômato
             copy_last_state();
             apply_rules();
+
+            // Transmite a nova geração a visualizadores remotos, se houver
+            stream_publish(++window.generation);
         }
     }
 }
@@ -191,6 +198,10 @@ automata_gui_update()
 void
 automata_gui_loop()
 {
+    // Publica o estado inicial, recebido por visualizadores que se conectem
+    // antes da primeira geração, ou com a aplicação pausada.
+    stream_publish(window.generation);
+
     // O loop para a interface gráfica acontece continuamente, se e somente se
     // a janela não tiver recebido um evento de encerramento.
     while(!glfwWindowShouldClose(window.ptr)) {
@@ -352,11 +363,11 @@ render_grid_cell(int x_cell, int y_cell, int state)
         return;
     case 1:
         // Células em recuperação são cinzas
-        glColor3f(0.5f, 0.5f, 0.5f);
+        glColor3ub(CELL_RECOVER_RGB);
         break;
     case 2:
         // Células excitadas são brancas
-        glColor3f(1.0f, 1.0f, 1.0f);
+        glColor3ub(CELL_EXCITED_RGB);
         break;
     default:
         // Estados diferentes destes indicam renderização